@@ -37,6 +37,18 @@
  * notification can be made conditional on rsp_event (i.e., the generic
  * hold-off mechanism provided by the ring macros). Frontends must set
  * rsp_event appropriately (e.g., using RING_FINAL_CHECK_FOR_RESPONSES()).
+ *
+ * Response coalescing: The backend may hold back completed responses and
+ * publish several of them with a single RING_PUSH_RESPONSES_AND_CHECK_NOTIFY()
+ * and notification, bounded by its rsp-coalesce-max and
+ * rsp-coalesce-usecs.
+ *
+ * Busy polling: If busy-poll is set for the stream, either end may spin on
+ * the producer index of the ring instead of waiting for a notification.
+ * While polling it leaves its req_event/rsp_event untouched, so the other
+ * end doesn't notify, and it must use RING_FINAL_CHECK_FOR_REQUESTS()/
+ * RING_FINAL_CHECK_FOR_RESPONSES() before it stops polling and waits for
+ * the event channel.
  */
 
 /*
@@ -184,13 +196,152 @@
  *      /local/domain/5/device/vsnd/0/card/0/device/0/stream/0/type = "p"
  *      /local/domain/5/device/vsnd/0/card/0/device/0/stream/1/type = "c"
  *
+ * busy-poll
+ *      Values:         <uint32_t>
+ *      Default Value:  0
+ *
+ *      The maximum time in microseconds the backend and the frontend may
+ *      busy-poll the stream's ring before waiting for an event channel
+ *      notification. Implementations may adapt the actual polling time to
+ *      the observed request interval within this budget. 0 disables polling.
+ *
+ *      For example,
+ *      /local/domain/5/device/vsnd/0/card/0/device/0/stream/0/busy-poll = "500"
+ *
+ *--------------------------- Configuration blob ------------------------------
+ *
+ * config
+ *      Values:         <string>
+ *
+ *      Optional. The complete configuration of the driver instance, i.e. all
+ *      card, device and stream nodes described above, in a single node, so
+ *      it can be read with one XenStore request. If published, the tool stack
+ *      publishes it in the same transaction as, and in addition to, the
+ *      individual nodes. The format is:
+ *
+ *      <version>:<length>\n<records>
+ *
+ *      version - XENSND_CONFIG_VERSION the blob was written with
+ *      length - length in octets of <records>
+ *      records - one "<path>=<value>\n" record per node, where <path> is
+ *        relative to the driver instance node. A record is split at its
+ *        first "=", so <value> may contain "=" while <path> never does.
+ *        <value> must not contain "\n": a node whose value contains "\n"
+ *        can't be represented and then the blob must not be published
+ *
+ *      If the node is not defined, its version is not known to the reader
+ *      or the length doesn't match, then the individual nodes must be read
+ *      instead. As the node is limited by the maximum XenStore payload size,
+ *      large configurations may not publish it at all.
+ *
+ *      For example,
+ *      /local/domain/5/device/vsnd/0/config = "1:64\ncard/0/short-name=Virtual audio\ncard/0/device/0/stream/0/type=p\n"
+ *
+ *--------------------------------- Features ---------------------------------
+ *
+ * The nodes below are written by the backend before it enters
+ * XenbusStateInitWait, so the frontend can read them before it publishes
+ * its transport parameters. They are not changed while connected.
+ *
+ * feature-pos-page
+ *      Values:         0/1 (boolean)
+ *      Default Value:  0
+ *
+ *      A value of "1" indicates that the backend supports a per stream
+ *      position page (see pos-ref below) and will publish the stream's
+ *      hardware pointer there.
+ *
+ * feature-max-segments
+ *      Values:         <uint8_t>
+ *      Default Value:  0
+ *
+ *      The maximum number of segments the backend accepts in a single
+ *      XENSND_OP_READ_SG/XENSND_OP_WRITE_SG request. If not defined or 0,
+ *      scatter/gather requests are not supported.
+ *
+ * max-ring-page-order
+ *      Values:         <uint32_t>
+ *      Default Value:  0
+ *
+ *      The maximum supported size of a stream's request ring buffer in units
+ *      of lb(machine pages), e.g. 0 == 1 page, 1 == 2 pages, 2 == 4 pages,
+ *      etc.
+ *
+ * feature-persistent
+ *      Values:         0/1 (boolean)
+ *      Default Value:  0
+ *
+ *      A value of "1" indicates that the backend can keep the grants of the
+ *      stream buffers (page directory and data pages) mapped after
+ *      XENSND_OP_CLOSE, so re-opening a stream with the same grants does
+ *      not need to map them again. The backend unmaps them all at the latest
+ *      on disconnect.
+ *
+ * feature-padded-ring
+ *      Values:         0/1 (boolean)
+ *      Default Value:  0
+ *
+ *      A value of "1" indicates that the backend supports the padded shared
+ *      ring layout, see padded-ring below.
+ *
+ * rsp-coalesce-max
+ *      Values:         <uint32_t>
+ *      Default Value:  1
+ *
+ *      The maximum number of responses the backend publishes with a single
+ *      notification. 0 or 1 means responses are not coalesced.
+ *
+ * rsp-coalesce-usecs
+ *      Values:         <uint32_t>
+ *      Default Value:  0
+ *
+ *      The maximum time in microseconds the backend holds back a completed
+ *      response in order to coalesce it with others. Frontends should take
+ *      it into account when choosing period and buffer sizes.
+ *
+ * feature-read-ahead
+ *      Values:         0/1 (boolean)
+ *      Default Value:  0
+ *
+ *      A value of "1" indicates that the backend supports read-ahead capture,
+ *      see XENSND_OPEN_FLAG_READ_AHEAD.
+ *
+ * feature-trigger
+ *      Values:         0/1 (boolean)
+ *      Default Value:  0
+ *
+ *      A value of "1" indicates that the backend supports XENSND_OP_TRIGGER.
+ *
+ * feature-shared-ring
+ *      Values:         0/1 (boolean)
+ *      Default Value:  0
+ *
+ *      A value of "1" indicates that the backend supports a single ring and
+ *      event channel shared by all streams of a card, see "Shared ring" below.
+ *
+ * feature-ctrl-page
+ *      Values:         0/1 (boolean)
+ *      Default Value:  0
+ *
+ *      A value of "1" indicates that the backend supports a per stream
+ *      control page (see ctrl-ref below).
+ *
+ * feature-reconfigure
+ *      Values:         0/1 (boolean)
+ *      Default Value:  0
+ *
+ *      A value of "1" indicates that the backend supports
+ *      XENSND_OP_RECONFIGURE. Must only be set if feature-trigger is set
+ *      as well, as reconfiguring a stream which has been started requires
+ *      XENSND_OP_TRIGGER_STOP.
+ *
  *****************************************************************************
  *                            Frontend XenBus Nodes
  *****************************************************************************
  *
  *----------------------- Request Transport Parameters -----------------------
  *
- * These are per stream.
+ * These are per stream, unless a shared ring is used.
  *
  * event-channel
  *      Values:         <string representing a positive integer>
@@ -202,7 +353,65 @@
  *      Values:         <string representing a positive integer>
  *
  *      The Xen grant reference granting permission for the backend to map
- *      a sole page in a single page sized ring buffer.
+ *      a sole page in a single page sized ring buffer. Only used if
+ *      ring-page-order is 0 or not defined.
+ *
+ * ring-page-order
+ *      Values:         <uint32_t>
+ *      Default Value:  0
+ *      Maximum Value:  max-ring-page-order
+ *
+ *      The size of the frontend allocated request ring buffer in units of
+ *      lb(machine pages), e.g. 0 == 1 page, 1 == 2 pages, 2 == 4 pages, etc.
+ *
+ * ring-ref%u
+ *      Values:         <string representing a positive integer>
+ *
+ *      The Xen grant reference granting permission for the backend to map
+ *      the N-th page of a multi-page ring buffer, N in
+ *      [0; (1 << ring-page-order) - 1]. Only used if ring-page-order is
+ *      greater than 0, in which case ring-ref is not published.
+ *
+ * padded-ring
+ *      Values:         0/1 (boolean)
+ *      Default Value:  0
+ *
+ *      A value of "1" indicates that the ring uses the padded layout, where
+ *      the indices written by the frontend (req_prod, rsp_event) and the ones
+ *      written by the backend (rsp_prod, req_event) live in separate cache
+ *      lines, see struct xen_sndif_padded_sring. Only valid if the backend
+ *      has set feature-padded-ring.
+ *
+ * pos-ref
+ *      Values:         <string representing a positive integer>
+ *
+ *      Optional. The Xen grant reference granting permission for the backend
+ *      to map the stream's position page, see "Position page" below.
+ *      Must only be published if the backend has set feature-pos-page.
+ *      If not published, the frontend learns of the consumed data only
+ *      from the responses to XENSND_OP_READ/XENSND_OP_WRITE.
+ *
+ * ctrl-ref
+ *      Values:         <string representing a positive integer>
+ *
+ *      Optional. The Xen grant reference granting permission for the backend
+ *      to map the stream's control page, see "Control page" below.
+ *      Must only be published if the backend has set feature-ctrl-page.
+ *      If published, volume and mute are exchanged through the control page
+ *      rather than through the buffer passed with XENSND_OP_OPEN.
+ *
+ * feature-persistent
+ *      Values:         0/1 (boolean)
+ *      Default Value:  0
+ *
+ *      A value of "1" indicates that the frontend reuses the same grants
+ *      for the page directory and the data pages of the stream buffer
+ *      on every XENSND_OP_OPEN where possible. Every grant ever passed to
+ *      the backend in a page directory or as a data page, including the ones
+ *      of an OPEN with different grants, stays valid until the backend has
+ *      disconnected, so the backend may keep any of them mapped. The frontend
+ *      must not revoke access to any of them before that. Only valid if the
+ *      backend has set feature-persistent.
  *
  * index
  *      Values:         <string representing a positive integer>
@@ -210,6 +419,35 @@
  *      After stream initialization it is assigned a unique ID (within the front
  *      driver), so every stream of the frontend can be identified by the
  *      backend by this ID.
+ *
+ *------------------------------- Shared ring --------------------------------
+ *
+ * If the backend has set feature-shared-ring, the frontend may publish
+ * event-channel and ring-ref (or ring-page-order and ring-ref%u) and
+ * padded-ring at card level instead of per stream, e.g.
+ * /local/domain/5/device/vsnd/0/card/0/ring-ref = "386"
+ * /local/domain/5/device/vsnd/0/card/0/event-channel = "15"
+ * Then a single ring and event channel carry the requests of all the streams
+ * of the card, addressed by stream_idx, and the streams of the card don't
+ * publish their own event-channel and ring-ref. All other per stream nodes,
+ * e.g. index and pos-ref, are still published per stream.
+ *
+ * Responses may come out of order, both for different streams and for
+ * requests of the same stream, e.g. a XENSND_OP_TRIGGER completing before
+ * the data requests held for a paused stream, so the frontend must match
+ * them by id. Data requests of a given stream are still completed in the
+ * order they were queued. The backend should serve the streams fairly, e.g.
+ * by the deadline of their pending requests, so a busy stream does not
+ * delay the others.
+ *
+ * As a request occupies its ring slot until it is responded to, the frontend
+ * must not have more than RING_SIZE / <number of streams of the card>
+ * (at least 1) requests of a single stream pending on a shared ring,
+ * including the ones held for a paused stream, so one stream cannot starve
+ * the others of ring slots.
+ *
+ * busy-poll stays a per stream node. The ring is polled with the largest
+ * busy-poll of the card's opened streams.
  */
 
 /*
@@ -229,15 +467,20 @@
  *                                       o Query backend device identification
  *                                         data.
  *                                       o Open and validate backend device.
+ *                                       o Publish backend features
+ *                                         (feature-xxx and max-xxx nodes).
  *                                                      |
  *                                                      |
  *                                                      V
  *                                      XenbusStateInitWait
  *
  * o Query frontend configuration
+ * o Query backend features.
  * o Allocate and initialize
- *   event channels per configured
- *   playback/capture stream.
+ *   rings and event channels per
+ *   configured playback/capture
+ *   stream, or per card if
+ *   a shared ring is used.
  * o Publish transport parameters
  *   that will be in effect during
  *   this connection.
@@ -275,7 +518,69 @@
  *
  * endian: <LE/BE>, may be absent
  *     LE - Little endian, BE - Big endian
+ *
+ * Samples of all channels of a frame are interleaved. Every sample of
+ * a linear format is stored in a container of the following size:
+ *     8, 16 and 32 bit formats - 1, 2 and 4 octets
+ *     24 bit formats - 4 octets, the sample occupies the 3 least significant
+ *       octets of the container (24-in-32), the most significant octet
+ *       is ignored
+ *     F32, F64 - 4 and 8 octets
+ *     IEC958 subframes - 4 octets
+ * Unsigned formats are offset binary, i.e. the zero level is
+ * 1 << (bits - 1). Float samples outside of [-1.0; 1.0] are clipped by
+ * the consumer.
+ *
+ * Companded and compressed formats:
+ *     MU_LAW, A_LAW - 1 octet per sample, companded as per ITU-T G.711
+ *     IMA_ADPCM - IMA/DVI ADPCM blocks of block_size octets per channel,
+ *       each decodable on its own, see below.
+ *
+ * IMA ADPCM block:
+ *          0                 1                  2                3        octet
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |           predictor[0]            |  step_index[0]  |    reserved     |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * +/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/|
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |      predictor[channels - 1]      |  step_index[]   |    reserved     |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                           data[0], channel 0                          |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * +/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/|
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                    data[0], channel channels - 1                      |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                           data[1], channel 0                          |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * +/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/|
+ * +-----------------+-----------------+-----------------+-----------------+
+ *
+ * predictor[i] - sint16_t, little endian, first sample of i-th channel in
+ *   the block, which is also the initial predictor of its decoder
+ * step_index[i] - uint8_t, initial step index of i-th channel, [0; 88]
+ * data[j] - 4 octets holding 8 consecutive samples of one channel as 4 bit
+ *   codes, the least significant nibble first
+ *
+ * This is the block layout of WAVE_FORMAT_DVI_ADPCM. The size of a block per
+ * channel, block_size, is chosen by the frontend with the block_size field
+ * of XENSND_OP_OPEN, in units of XENSND_IMA_ADPCM_BLOCK_UNIT octets, and
+ * defaults to XENSND_IMA_ADPCM_BLOCK_SIZE octets. A block holds
+ * XENSND_IMA_ADPCM_FRAMES_PER_BLOCK(block_size) frames and is
+ * block_size * pcm_channels octets long, e.g. with a block_size of
+ * 84 octets a block holds 161 frames, about 20 ms at 8000 Hz.
+ * No codec state is carried between blocks, so dropped data only affects
+ * whole blocks. For IMA_ADPCM the offsets and lengths of READ/WRITE requests
+ * and of every READ_SG/WRITE_SG segment must be multiples of the block
+ * length, the read-ahead capture buffer is rounded down to whole blocks and
+ * data is always produced, consumed and dropped in whole blocks, so frames of
+ * the position page advances in whole blocks as well.
  */
+#define XENSND_IMA_ADPCM_BLOCK_UNIT         4
+#define XENSND_IMA_ADPCM_BLOCK_SIZE         64
+#define XENSND_IMA_ADPCM_FRAMES_PER_BLOCK(block_size) \
+	(1 + ((block_size) - 4) * 2)
+
 #define XENSND_PCM_FORMAT_S8            0
 #define XENSND_PCM_FORMAT_U8            1
 #define XENSND_PCM_FORMAT_S16_LE        2
@@ -314,6 +619,25 @@
 #define XENSND_OP_GET_VOLUME            5
 #define XENSND_OP_MUTE                  6
 #define XENSND_OP_UNMUTE                7
+#define XENSND_OP_READ_SG               8
+#define XENSND_OP_WRITE_SG              9
+#define XENSND_OP_TRIGGER               10
+#define XENSND_OP_RECONFIGURE           11
+
+#define XENSND_OP_TRIGGER_START         0
+#define XENSND_OP_TRIGGER_STOP          1
+#define XENSND_OP_TRIGGER_PAUSE         2
+#define XENSND_OP_TRIGGER_RESUME        3
+
+/*
+ * OPEN FLAGS.
+ */
+#define XENSND_OPEN_FLAG_READ_AHEAD     (1 << 0)
+
+/*
+ * CONTROL PAGE.
+ */
+#define XENSND_CTRL_MAX_CHANNELS        256
 
 /*
  * XENSTORE FIELD AND PATH NAME STRINGS, HELPERS.
@@ -338,6 +662,31 @@
 #define XENSND_FIELD_SAMPLE_RATES            "sample-rates"
 #define XENSND_FIELD_SAMPLE_FORMATS          "sample-formats"
 #define XENSND_FIELD_BUFFER_SIZE             "buffer-size"
+#define XENSND_FIELD_POS_REF                 "pos-ref"
+#define XENSND_FIELD_FEATURE_POS_PAGE        "feature-pos-page"
+#define XENSND_FIELD_FEATURE_MAX_SEGMENTS    "feature-max-segments"
+#define XENSND_FIELD_MAX_RING_PAGE_ORDER     "max-ring-page-order"
+#define XENSND_FIELD_RING_PAGE_ORDER         "ring-page-order"
+#define XENSND_FIELD_RING_REF_FMT            "ring-ref%u"
+#define XENSND_FIELD_FEATURE_PERSISTENT      "feature-persistent"
+#define XENSND_FIELD_CONFIG                  "config"
+#define XENSND_FIELD_FEATURE_PADDED_RING     "feature-padded-ring"
+#define XENSND_FIELD_PADDED_RING             "padded-ring"
+#define XENSND_FIELD_BUSY_POLL               "busy-poll"
+#define XENSND_FIELD_RSP_COALESCE_MAX        "rsp-coalesce-max"
+#define XENSND_FIELD_RSP_COALESCE_USECS      "rsp-coalesce-usecs"
+#define XENSND_FIELD_FEATURE_READ_AHEAD      "feature-read-ahead"
+#define XENSND_FIELD_FEATURE_TRIGGER         "feature-trigger"
+#define XENSND_FIELD_FEATURE_SHARED_RING     "feature-shared-ring"
+#define XENSND_FIELD_FEATURE_CTRL_PAGE       "feature-ctrl-page"
+#define XENSND_FIELD_CTRL_REF                "ctrl-ref"
+#define XENSND_FIELD_FEATURE_RECONFIGURE     "feature-reconfigure"
+
+/* Configuration blob format */
+#define XENSND_CONFIG_VERSION                1
+#define XENSND_CONFIG_HEADER_SEPARATOR       ":"
+#define XENSND_CONFIG_RECORD_SEPARATOR       "\n"
+#define XENSND_CONFIG_VALUE_SEPARATOR        "="
 
 /* Stream type field values. */
 #define XENSND_STREAM_TYPE_PLAYBACK          "p"
@@ -444,7 +793,9 @@
  *
  * The two halves of a Para-virtual sound driver communicates with
  * each other using a shared page and an event channel.
- * Shared page contains a ring with request/response packets.
+ * Shared page contains a ring with request/response packets. If negotiated
+ * with ring-page-order, the ring spans 1 << ring-page-order contiguous pages
+ * (in the order of ring-ref%u) instead of a single page.
  *
  * All request packets have the same length (16 octets)
  *
@@ -456,7 +807,7 @@
  * +-----------------+-----------------+-----------------+-----------------+
  * |                                pcm_rate                               |
  * +-----------------+-----------------+-----------------+-----------------+
- * |  pcm_format     |  pcm_channels   |             reserved              |
+ * |  pcm_format     |  pcm_channels   |      flags      |   block_size    |
  * +-----------------+-----------------+-----------------+-----------------+
  * |                         gref_directory_start                          |
  * +-----------------+-----------------+-----------------+-----------------+
@@ -468,12 +819,45 @@
  * pcm_rate - uint32_t, stream data rate, Hz
  * pcm_format - uint8_t, XENSND_PCM_FORMAT_XXX value
  * pcm_channels - uint8_t, number of channels of this stream
+ * flags - uint8_t, XENSND_OPEN_FLAG_XXX values, 0 if none
+ * block_size - uint8_t, XENSND_PCM_FORMAT_IMA_ADPCM only: size of a block per
+ *   channel in units of XENSND_IMA_ADPCM_BLOCK_UNIT octets, at least 2.
+ *   0 selects XENSND_IMA_ADPCM_BLOCK_SIZE. Must be 0 for all other formats
  * gref_directory_start - grant_ref_t, a reference to the first shared page
  *   describing shared buffer references. At least one page exists. If shared
  *   buffer size exceeds what can be addressed by this single page, then
  *   reference to the next page must be supplied (gref_dir_next_page below
  *   is not NULL)
  *
+ * The flags and block_size octets were reserved in earlier versions of this
+ * protocol. Frontends must set all flags not defined below and block_size of
+ * formats other than IMA_ADPCM to 0. Flags requiring optional features are
+ * only honoured for streams which negotiated those features, see below.
+ *
+ * Open flags:
+ * XENSND_OPEN_FLAG_READ_AHEAD - capture streams only, requires
+ *   feature-read-ahead and both a position page (pos-ref) and a control page
+ *   (ctrl-ref) for the stream, which frontends not aware of this flag never
+ *   publish. An OPEN with this flag for a playback stream or a stream without
+ *   pos-ref or ctrl-ref is completed with XENSND_RSP_ERROR. Right after
+ *   XENSND_OP_OPEN the whole shared
+ *   buffer (rounded down to whole frames) belongs to the backend, which
+ *   starts capturing and treats it as a circular buffer: it continuously
+ *   writes captured frames into it and announces new data only by
+ *   increasing frames of the position page. Announced data belongs to the
+ *   frontend until it acknowledges it with XENSND_OP_READ, where
+ *   [offset; offset + length) is data the frontend has already consumed:
+ *   the region is handed back to the backend, which may overwrite it at
+ *   once, and the request is completed immediately. Regions are
+ *   acknowledged in buffer order. If the backend has no free space to write
+ *   captured frames to, it drops them and increments xruns of the position
+ *   page.
+ *   As the backend may overwrite any part of the shared buffer, no other
+ *   payload can be exchanged through it: volume and mute are controlled
+ *   through the control page only, and XENSND_OP_READ_SG as well as
+ *   XENSND_OP_SET_VOLUME, XENSND_OP_GET_VOLUME, XENSND_OP_MUTE and
+ *   XENSND_OP_UNMUTE are completed with XENSND_RSP_ERROR.
+ *
  * Shared page for XENSND_OP_OPEN buffer descriptor (gref_directory in the
  *   request) employs a list of pages, describing all pages of the shared data
  *   buffer:
@@ -498,6 +882,11 @@
  * gref[i] - grant_ref_t, reference to a shared page of the buffer
  *   allocated at XENSND_OP_OPEN
  *
+ * The data pages are listed in buffer order, so the backend can first walk
+ * the directory pages to collect all the grefs and then map the whole buffer
+ * with a single batched grant operation into one virtually contiguous area.
+ * The total number of grefs must not exceed what is needed for buffer-size.
+ *
  * Request close - close an opened pcm stream:
  *          0                 1                  2                3        octet
  * +-----------------+-----------------+-----------------+-----------------+
@@ -537,6 +926,61 @@
  * length - uint32_t, read or write data length
  *
  *
+ * Request scatter/gather read/write - read or write multiple regions of the
+ *   shared buffer at once, e.g. a region wrapping around the end of a circular
+ *   buffer or several queued periods:
+ *          0                 1                  2                3        octet
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                 id                |    operation    |     stream_idx  |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |    num_segs     |                      reserved                       |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                            seg_list_offset                            |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                               reserved                                |
+ * +-----------------+-----------------+-----------------+-----------------+
+ *
+ * id - uint16_t, private guest value, echoed in response
+ * operation - uint8_t, XENSND_OP_READ_SG/XENSND_OP_WRITE_SG
+ * stream_idx - uint8_t, index of the stream ("streams_idx" XenStore entry
+ *   of the stream)
+ * num_segs - uint8_t, number of segments in the segment list, must be at
+ *   least 1 and not exceed backend's feature-max-segments
+ * seg_list_offset - uint32_t, offset of the segment list within the shared
+ *   buffer passed with XENSND_OP_OPEN, must be a multiple of 4 octets
+ *
+ * Segment list:
+ *          0                 1                  2                3        octet
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                               offset[0]                               |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                                length[0]                              |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * +/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/|
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                          offset[num_segs - 1]                         |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                          length[num_segs - 1]                         |
+ * +-----------------+-----------------+-----------------+-----------------+
+ *
+ * offset[i] - uint32_t, read or write data offset of the i-th segment within
+ *   the shared buffer passed with XENSND_OP_OPEN
+ * length[i] - uint32_t, read or write data length of the i-th segment
+ *
+ * Segments are processed in list order and the request is completed with
+ * a single response once all of them are done. The segment list must not
+ * overlap with any of the segments it describes and must not be modified
+ * by the frontend until the response is received.
+ *
+ * As the segment list lives in memory writable by the frontend, the backend
+ * copies it once before validating and using it. The backend responds with
+ * XENSND_RSP_ERROR without processing any segment if:
+ *  o num_segs is 0 or exceeds feature-max-segments,
+ *  o seg_list_offset is not a multiple of 4 octets,
+ *  o the segment list or any of the segments is not fully within the
+ *    shared buffer.
+ *
+ *
  * Request set/get volume - set/get channels' volume of the stream given:
  *          0                 1                  2                3        octet
  * +-----------------+-----------------+-----------------+-----------------+
@@ -554,7 +998,7 @@
  * stream_idx - uint8_t, index of the stream ("streams_idx" XenStore entry
  *   of the stream)
  * Buffer passed with XENSND_OP_OPEN is used to exchange volume
- * values:
+ * values (not used if the stream has a control page):
  *
  *          0                 1                  2                3        octet
  * +-----------------+-----------------+-----------------+-----------------+
@@ -589,7 +1033,7 @@
  * stream_idx - uint8_t, index of the stream ("streams_idx" XenStore entry
  *   of the stream)
  * Buffer passed with XENSND_OP_OPEN is used to exchange mute/unmute
- * values:
+ * values (not used if the stream has a control page):
  *
  *          0                 1                  2                3        octet
  * +-----------------+-----------------+-----------------+-----------------+
@@ -607,6 +1051,98 @@
  * field
  *
  *
+ * Request trigger - start, stop, pause or resume an opened stream, keeping
+ *   its buffer and device configuration:
+ *          0                 1                  2                3        octet
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                 id                |    operation    |     stream_idx  |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |      type       |                      reserved                       |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                               reserved                                |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                               reserved                                |
+ * +-----------------+-----------------+-----------------+-----------------+
+ *
+ * id - uint16_t, private guest value, echoed in response
+ * operation - uint8_t, XENSND_OP_TRIGGER
+ * stream_idx - uint8_t, index of the stream ("streams_idx" XenStore entry
+ *   of the stream)
+ * type - uint8_t, XENSND_OP_TRIGGER_XXX value:
+ *   XENSND_OP_TRIGGER_START - start an idle stream
+ *   XENSND_OP_TRIGGER_STOP - stop a running or paused stream, making it idle.
+ *     All its pending data requests are completed with XENSND_RSP_ERROR
+ *     before the response to the trigger, and frames and xruns of the
+ *     position page are reset to 0. For read-ahead capture the whole shared
+ *     buffer belongs to the backend again, as right after XENSND_OP_OPEN
+ *   XENSND_OP_TRIGGER_PAUSE - pause a running stream keeping its position.
+ *     Its pending data requests are kept by the backend and completed after
+ *     the stream is resumed, or with XENSND_RSP_ERROR if it is stopped or
+ *     closed
+ *   XENSND_OP_TRIGGER_RESUME - resume a paused stream from its position
+ *
+ * Data requests here are XENSND_OP_READ, XENSND_OP_WRITE, XENSND_OP_READ_SG
+ * and XENSND_OP_WRITE_SG. An opened stream is in one of these states:
+ *  o idle - right after XENSND_OP_OPEN or XENSND_OP_TRIGGER_STOP, with no
+ *    pending data requests. The stream is started either by
+ *    XENSND_OP_TRIGGER_START or implicitly by its first data request, so
+ *    frontends not using triggers are not affected and a stopped stream is
+ *    restarted in the same way as a newly opened one. A read-ahead capture
+ *    stream is an exception: XENSND_OP_OPEN starts it right away and, once
+ *    stopped, it is only restarted by XENSND_OP_TRIGGER_START; until then
+ *    its data requests are completed with XENSND_RSP_ERROR
+ *  o running - data requests are served
+ *  o paused - the frontend must not send data requests; the backend
+ *    completes such requests immediately with XENSND_RSP_ERROR.
+ * As the pending requests of a paused stream were all queued before the
+ * pause, the ring slot used by XENSND_OP_TRIGGER_PAUSE is free again once
+ * it is completed, so there is always room for the trigger that releases
+ * them. A trigger not valid in the current state of the stream, e.g.
+ * XENSND_OP_TRIGGER_RESUME of a running stream, is completed with
+ * XENSND_RSP_ERROR and has no effect.
+ * XENSND_OP_CLOSE, and XENSND_OP_OPEN of an already opened stream, complete
+ * all pending data requests of the stream, including the ones held for
+ * a paused stream, with XENSND_RSP_ERROR before their own response, so no
+ * ring slot stays occupied.
+ *
+ *
+ * Request reconfigure - change PCM parameters of an opened stream, keeping
+ *   the buffer passed with XENSND_OP_OPEN:
+ *          0                 1                  2                3        octet
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                 id                |    operation    |     stream_idx  |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                                pcm_rate                               |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |  pcm_format     |  pcm_channels   |    reserved     |   block_size    |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                               reserved                                |
+ * +-----------------+-----------------+-----------------+-----------------+
+ *
+ * id - uint16_t, private guest value, echoed in response
+ * operation - uint8_t, XENSND_OP_RECONFIGURE
+ * stream_idx - uint8_t, index of the stream ("streams_idx" XenStore entry
+ *   of the stream)
+ * pcm_rate - uint32_t, stream data rate, Hz
+ * pcm_format - uint8_t, XENSND_PCM_FORMAT_XXX value
+ * pcm_channels - uint8_t, number of channels of this stream
+ * block_size - uint8_t, same as for XENSND_OP_OPEN
+ *
+ * The stream must be idle (see XENSND_OP_TRIGGER), i.e. either no data
+ * request was sent since XENSND_OP_OPEN and it is not a read-ahead capture
+ * stream, or it was stopped with XENSND_OP_TRIGGER_STOP. A running or paused
+ * stream doesn't qualify. An idle stream has no pending data requests.
+ * The shared buffer, its grant mappings and the open flags are kept, and the
+ * stream stays idle: it is started again in the same way as any idle stream,
+ * in particular a stopped read-ahead capture stream does not start capturing
+ * until XENSND_OP_TRIGGER_START. frames and xruns of the position page are
+ * reset to 0. The frontend is responsible for the buffer being large enough
+ * for the new parameters.
+ * If the stream is in any other state or the parameters are not supported,
+ * the backend responds with XENSND_RSP_ERROR and the stream keeps both its
+ * state and its previous parameters.
+ *
+ *
  * All response packets have the same length (64 bytes)
  *
  * Response for all requests:
@@ -625,7 +1161,106 @@
  * stream_idx - uint8_t, copied from request
  * operation - uint8_t, XENSND_OP_XXX - copied from request
  * status - int8_t, response status (XENSND_RSP_???)
+ *
+ *
+ * Position page - hardware pointer of the stream published by the backend:
+ *          0                 1                  2                3        octet
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                                  seq                                  |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                                 xruns                                 |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                              frames (low)                             |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                              frames (high)                            |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                            timestamp (low)                            |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                            timestamp (high)                           |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                                 drift                                 |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                               reserved                                |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * +/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/|
+ * +-----------------+-----------------+-----------------+-----------------+
+ *
+ * seq - uint32_t, sequence counter. The backend increments it before
+ *   (making it odd) and after (making it even again) every update of the
+ *   page, with write barriers in between
+ * xruns - uint32_t, number of underruns (playback) or overruns (capture)
+ *   of the stream since the last XENSND_OP_OPEN or XENSND_OP_TRIGGER_STOP
+ * frames - uint64_t, number of frames consumed from (playback) or put into
+ *   (capture) the shared buffer since the last XENSND_OP_OPEN or
+ *   XENSND_OP_TRIGGER_STOP of the stream, monotonically increasing in
+ *   between. Both xruns and frames are reset to 0 by these requests
+ * timestamp - uint64_t, backend's monotonic time in nanoseconds at which
+ *   frames was last updated. Only the difference between two timestamps
+ *   is meaningful to the frontend
+ * drift - int32_t, backend's estimate of the clock drift of the host device
+ *   relative to pcm_rate as seen by the frontend, in parts per billion.
+ *   Positive if the device consumes (playback) or produces (capture) frames
+ *   faster than pcm_rate. A backend compensating the drift, e.g. by adaptive
+ *   resampling, still reports the estimate before compensation. 0 if unknown
+ *
+ * The page is written by the backend only. The frontend reads it lock-free,
+ * e.g. from its timer or pointer callback:
+ *  o read seq, retry while it is odd
+ *  o read barrier, read xruns, frames, timestamp and drift
+ *  o read barrier, re-read seq, retry if it differs from the first read.
+ * The remaining octets of the page are reserved and must be zero.
+ *
+ *
+ * Control page - volume and mute of the stream set by the frontend:
+ *          0                 1                  2                3        octet
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                                  seq                                  |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                               reserved                                |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                               volume[0]                               |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * +/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/|
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                  volume[XENSND_CTRL_MAX_CHANNELS - 1]                 |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |     mute[0]     |     mute[1]     |     mute[2]     |     mute[3]     |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * +/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/|
+ * +-----------------+-----------------+-----------------+-----------------+
+ *
+ * seq - uint32_t, sequence counter. The frontend increments it before
+ *   (making it odd) and after (making it even again) every update of the
+ *   page, with write barriers in between
+ * volume[i] - sint32_t, volume of i-th channel, in the same units as for
+ *   XENSND_OP_SET_VOLUME
+ * mute[i] - uint8_t, non-zero if i-th channel is muted
+ *
+ * The page is written by the frontend only and always holds the current
+ * values for the first pcm_channels channels, starting with 0 (0dBm, not
+ * muted) for all of them. The backend reads it lock-free whenever it sees
+ * fit, e.g. between periods, and on XENSND_OP_OPEN, in the same way the
+ * frontend reads the position page, with these differences, as the page is
+ * controlled by the less privileged side:
+ *  o the backend copies the values out of the page and uses the copy only
+ *  o it retries a bounded number of times only, e.g. till the next period;
+ *    if seq is still odd or keeps changing it keeps the previous values
+ *  o it only uses volume[i] and mute[i] for i < pcm_channels and clamps
+ *    volume values to the range it supports.
+ * A changed seq indicates new values.
+ * XENSND_OP_SET_VOLUME, XENSND_OP_GET_VOLUME, XENSND_OP_MUTE and
+ * XENSND_OP_UNMUTE are not used for a stream with a control page.
+ * The remaining octets of the page are reserved and must be zero.
+ */
+
+/*
+ * Compile time checks of the wire layout, if the compiler supports them.
  */
+#if defined(__cplusplus) && __cplusplus >= 201103L
+#define XENSND_STATIC_ASSERT(cond, msg)	static_assert(cond, msg)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define XENSND_STATIC_ASSERT(cond, msg)	_Static_assert(cond, msg)
+#endif
 
 struct xensnd_request {
     uint8_t raw[16];
@@ -40,7 +40,8 @@ struct xensnd_open_req {
 	uint8_t pcm_format;
 	uint8_t pcm_channels;
 	/* in Hz */
-	uint16_t __reserved0;
+	uint8_t flags;
+	uint8_t block_size;
 	grant_ref_t gref_directory_start;
 } __attribute__((packed));
 
@@ -50,6 +51,11 @@ struct xensnd_page_directory {
 	grant_ref_t gref[0];
 } __attribute__((packed));
 
+/* Maximum number of data page grefs a single directory page can hold. */
+#define XENSND_NUM_GREFS_PER_PAGE(page_size) \
+	(((page_size) - sizeof(struct xensnd_page_directory)) / \
+	sizeof(grant_ref_t))
+
 struct xensnd_close_req {
 } __attribute__((packed));
 
@@ -63,6 +69,17 @@ struct xensnd_read_req {
 	uint32_t len;
 } __attribute__((packed));
 
+struct xensnd_sg_seg {
+	uint32_t offset;
+	uint32_t len;
+} __attribute__((packed));
+
+struct xensnd_rw_sg_req {
+	uint8_t num_segs;
+	uint8_t __reserved0[3];
+	uint32_t seg_list_offset;
+} __attribute__((packed));
+
 struct xensnd_get_vol_req {
 } __attribute__((packed));
 
@@ -75,6 +92,18 @@ struct xensnd_mute_req {
 struct xensnd_unmute_req {
 } __attribute__((packed));
 
+struct xensnd_trigger_req {
+	uint8_t type;
+} __attribute__((packed));
+
+struct xensnd_reconfigure_req {
+	uint32_t pcm_rate;
+	uint8_t pcm_format;
+	uint8_t pcm_channels;
+	uint8_t __reserved0;
+	uint8_t block_size;
+} __attribute__((packed));
+
 struct xensnd_req {
 	union {
 		struct xensnd_request raw;
@@ -91,6 +120,10 @@ struct xensnd_req {
 				struct xensnd_set_vol_req set_vol;
 				struct xensnd_mute_req mute;
 				struct xensnd_unmute_req unmute;
+				struct xensnd_rw_sg_req read_sg;
+				struct xensnd_rw_sg_req write_sg;
+				struct xensnd_trigger_req trigger;
+				struct xensnd_reconfigure_req reconfigure;
 			} op;
 		} data;
 	} u;
@@ -108,7 +141,83 @@ struct xensnd_resp {
 	} u;
 };
 
+struct xensnd_pos_page {
+	uint32_t seq;
+	uint32_t xruns;
+	uint64_t frames;
+	uint64_t timestamp;
+	int32_t drift;
+	uint32_t __reserved0;
+} __attribute__((packed));
+
+struct xensnd_ctrl_page {
+	uint32_t seq;
+	uint32_t __reserved0;
+	int32_t volume[XENSND_CTRL_MAX_CHANNELS];
+	uint8_t mute[XENSND_CTRL_MAX_CHANNELS];
+} __attribute__((packed));
+
 DEFINE_RING_TYPES(xen_sndif, struct xensnd_req,
 		struct xensnd_resp);
 
+/*
+ * Padded shared ring layout, used instead of struct xen_sndif_sring if
+ * padded-ring is negotiated. The indices written by the frontend and by the
+ * backend are kept in separate cache lines, so producer and consumer do not
+ * bounce the same line on every request. Entries are the same as in the
+ * classic layout and all the generic RING_XXX macros apply, except that
+ * the shared ring must be initialized with XENSND_PADDED_SHARED_RING_INIT.
+ * On the plain publish and consume paths both ends may use a release store
+ * of the producer index instead of the write barrier before it, and an
+ * acquire load of the producer index instead of the read barrier after it.
+ * The barrier between publishing an index and reading the peer's event
+ * index, i.e. in RING_PUSH_{REQUESTS,RESPONSES}_AND_CHECK_NOTIFY() and
+ * RING_FINAL_CHECK_FOR_{REQUESTS,RESPONSES}(), orders a store against a
+ * later load and must stay a full barrier, or notifications get lost.
+ */
+#define XENSND_CACHE_LINE_SIZE	64
+
+struct xen_sndif_padded_sring {
+	/* Written by the frontend. */
+	RING_IDX req_prod, rsp_event;
+	uint8_t __pad0[XENSND_CACHE_LINE_SIZE - 2 * sizeof(RING_IDX)];
+	/* Written by the backend. */
+	RING_IDX rsp_prod, req_event;
+	uint8_t __pad1[XENSND_CACHE_LINE_SIZE - 2 * sizeof(RING_IDX)];
+	union xen_sndif_sring_entry ring[1];
+};
+
+struct xen_sndif_padded_front_ring {
+	RING_IDX req_prod_pvt;
+	RING_IDX rsp_cons;
+	unsigned int nr_ents;
+	struct xen_sndif_padded_sring *sring;
+};
+
+struct xen_sndif_padded_back_ring {
+	RING_IDX rsp_prod_pvt;
+	RING_IDX req_cons;
+	unsigned int nr_ents;
+	struct xen_sndif_padded_sring *sring;
+};
+
+#define XENSND_PADDED_SHARED_RING_INIT(_s) do {				\
+	(_s)->req_prod = (_s)->rsp_prod = 0;				\
+	(_s)->req_event = (_s)->rsp_event = 1;				\
+	(void)memset((_s)->__pad0, 0, sizeof((_s)->__pad0));		\
+	(void)memset((_s)->__pad1, 0, sizeof((_s)->__pad1));		\
+} while (0)
+
+/* Wire layout checks: every ring entry is exactly 16 octets. */
+#ifdef XENSND_STATIC_ASSERT
+XENSND_STATIC_ASSERT(sizeof(struct xensnd_req) ==
+		sizeof(struct xensnd_request), "xensnd_req must be 16 octets");
+XENSND_STATIC_ASSERT(sizeof(struct xensnd_resp) ==
+		sizeof(struct xensnd_response), "xensnd_resp must be 16 octets");
+XENSND_STATIC_ASSERT(sizeof(struct xensnd_pos_page) == 32,
+		"xensnd_pos_page layout mismatch");
+XENSND_STATIC_ASSERT(sizeof(struct xensnd_ctrl_page) == 1288,
+		"xensnd_ctrl_page layout mismatch");
+#endif
+
 #endif /* __XEN_PUBLIC_IO_XENSND_LINUX_H__ */
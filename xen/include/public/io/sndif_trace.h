@@ -0,0 +1,149 @@
+/******************************************************************************
+ * sndif_trace.h
+ *
+ * Recorded ring traffic trace format of the Xen sound-device I/O interface.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __XEN_PUBLIC_IO_XENSND_TRACE_H__
+#define __XEN_PUBLIC_IO_XENSND_TRACE_H__
+
+#include "sndif.h"
+
+/*
+ * A trace is a file written by a backend recording the requests it picks up
+ * from and the responses it puts onto the rings of its frontends, so the
+ * exact traffic can later be replayed against a backend. The file consists
+ * of a header followed by fixed size records, so it can be memory mapped and
+ * indexed directly. All values are little endian.
+ *
+ * Trace header:
+ *          0                 1                  2                3        octet
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                                 magic                                 |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |              version              |              rec_size             |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                                 flags                                 |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                               reserved                                |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                           start_time (low)                            |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                           start_time (high)                           |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                               reserved                                |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                               reserved                                |
+ * +-----------------+-----------------+-----------------+-----------------+
+ *
+ * magic - uint32_t, XENSND_TRACE_MAGIC
+ * version - uint16_t, XENSND_TRACE_VERSION the trace was written with
+ * rec_size - uint16_t, size in octets of every record. Readers must use it
+ *   to step over records, as later versions may append fields
+ * flags - uint32_t, XENSND_TRACE_FLAG_XXX values
+ * start_time - uint64_t, wall clock time in nanoseconds since the Epoch
+ *   at which recording started
+ *
+ * Trace record:
+ *          0                 1                  2                3        octet
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                            timestamp (low)                            |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                            timestamp (high)                           |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |               domid               |     drv_idx     |      type       |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                               reserved                                |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                                 raw[0]                                |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * +/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/\/|
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                                 raw[3]                                |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                          payload_hash (low)                           |
+ * +-----------------+-----------------+-----------------+-----------------+
+ * |                          payload_hash (high)                          |
+ * +-----------------+-----------------+-----------------+-----------------+
+ *
+ * timestamp - uint64_t, time in nanoseconds since start_time at which the
+ *   backend picked up the request or pushed the response
+ * domid - uint16_t, domain ID of the frontend
+ * drv_idx - uint8_t, index of the driver instance in the frontend
+ * type - uint8_t, XENSND_TRACE_REC_XXX value
+ * raw - the 16 octets of the request or response as seen on the ring
+ * payload_hash - uint64_t, 64-bit FNV-1a hash of the shared buffer data
+ *   the record refers to. Only valid if XENSND_TRACE_FLAG_HASH is set in
+ *   the trace header, 0 otherwise. The data hashed is:
+ *   o XENSND_OP_WRITE request - the region [offset; offset + length)
+ *   o XENSND_OP_WRITE_SG request - the data of all the segments
+ *     concatenated in list order, as a single hash
+ *   o XENSND_OP_SET_VOLUME, XENSND_OP_MUTE and XENSND_OP_UNMUTE requests -
+ *     the values passed in the shared buffer
+ *   o XENSND_OP_READ and XENSND_OP_READ_SG responses - the data read, in
+ *     the same way as for the corresponding write requests
+ *   o XENSND_OP_GET_VOLUME response - the values returned in the shared
+ *     buffer
+ *   o any other request or response and any response with a status other
+ *     than XENSND_RSP_OKAY - nothing, payload_hash is 0
+ *
+ * Both structures below are naturally aligned, so their layout doesn't
+ * depend on the compiler.
+ */
+#define XENSND_TRACE_MAGIC              0x52545358 /* "XSTR" */
+#define XENSND_TRACE_VERSION            1
+
+#define XENSND_TRACE_FLAG_HASH          (1 << 0)
+
+#define XENSND_TRACE_REC_REQUEST        0
+#define XENSND_TRACE_REC_RESPONSE       1
+
+struct xensnd_trace_hdr {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t rec_size;
+    uint32_t flags;
+    uint32_t __reserved0;
+    uint64_t start_time;
+    uint64_t __reserved1;
+};
+
+struct xensnd_trace_rec {
+    uint64_t timestamp;
+    uint16_t domid;
+    uint8_t drv_idx;
+    uint8_t type;
+    uint32_t __reserved0;
+    union {
+        struct xensnd_request req;
+        struct xensnd_response rsp;
+    } u;
+    uint64_t payload_hash;
+};
+
+#ifdef XENSND_STATIC_ASSERT
+XENSND_STATIC_ASSERT(sizeof(struct xensnd_trace_hdr) == 32,
+        "xensnd_trace_hdr must be 32 octets");
+XENSND_STATIC_ASSERT(sizeof(struct xensnd_trace_rec) == 40,
+        "xensnd_trace_rec must be 40 octets");
+#endif
+
+#endif /* __XEN_PUBLIC_IO_XENSND_TRACE_H__ */